@@ -1,5 +1,7 @@
 #include <fxcg/display.h>
 #include <fxcg/keyboard.h>
+#include <fxcg/file.h>
+#include <fxcg/rtc.h>
 
 /***************************************************************
  *  Copyright (c) 2023 George Newman
@@ -41,16 +43,52 @@ const int HEIGHT = 215; // Screen height in pixels
 const float X_OFFSET = 250; // Center renders in screen
 const float Y_OFFSET = HEIGHT / 2.0 + 5; // Center renders in screen
 const float ZOOM = 95.0; // Zoom into renders
+const float ZOOM_FACTOR = 1.25; // Each flythrough frame is this much deeper than the last
+#define SCREEN_PIXELS (384 * 216) // (WIDTH + 1) * (HEIGHT + 1), array sizes can't use the constants above
+#define MAX_ORBIT 100 // Origin plus one point per iteration, MAX_ITERATIONS is at most 99
+#define OVERLAY_LINES 320 // 18 for the axies, 3 for each of the 99 segments of a full trace and 1 for the cursor
+#define OVERLAY_PIXELS 6144 // Render pixels the overlay can cover at once, about 30KB, the axies and longest trace need 5848
+
+// Which setting an overlay line belongs to, so each can be cleared on its own
+#define LAYER_AXIS 0
+#define LAYER_TRACE 1
+#define LAYER_CURSOR 2
+#define LAYER_MOVED 3 // Trace lines about to be taken off because their segment moved
+
+#define TILE_SIZE 16 // Renders are drawn in square tiles
+#define TILES_X 24 // 384 / TILE_SIZE
+#define TILES_Y 12 // 192 rows under the status bar / TILE_SIZE
+#define TILE_SAMPLES 2 // Samples across and down each tile in the cost pre-pass
+#define PIXEL_COST 4 // Rough cost of colouring a pixel, counted in iterations
+#define TICKS_PER_DAY (128 * 60 * 60 * 24) // RTC_GetTicks() counts from midnight, going back to 0 the next day
+
+#define ZOOM_WIDTH 384 // Flythrough frames cover the screen under the status bar
+#define ZOOM_HEIGHT 192
+#define ZOOM_FRAMES 30 // Frames recorded after the first one
+#define ZOOM_CHECK_FRAMES 5 // Every this many frames is checked for resampling mistakes, so they cannot build up
+#define ZOOM_CHECK 8 // Checks compute one pixel exactly in each block of this many pixels across and down
+#define CHECK_X (ZOOM_WIDTH / ZOOM_CHECK)
+#define CHECK_Y (ZOOM_HEIGHT / ZOOM_CHECK)
+#define ZOOM_BUFFER 1024 // Bytes streamed to storage at once
+#define ZOOM_FILE_SIZE 655360 // Files have to be created at a fixed size, 30 frames at 50 iterations and an exact pass fit
+#define ZOOM_FILE "\\\\fls0\\ZOOM.bin"
+// Most bytes a frame can take, when every pixel changed by too much to store as a nibble
+#define ZOOM_FRAME_MAX (4 + ZOOM_WIDTH * ZOOM_HEIGHT * 3 / 2 + 2 * (ZOOM_WIDTH * ZOOM_HEIGHT / 255 + 1))
 
 // Define global variables
 int MAX_ITERATIONS = 20; // 20 reccomended, 10 min, 100 max
-int TRACE = 1; // 0 = off, 1 = on
-int LIVE_RENDER = 1; // 0 = off, 1 = on
+int TRACE = 1; // 0 = off, 1 = on, 2 = follow cursor
+int LIVE_RENDER = 1; // 0 = off, 1 = on, 2 = cheap tiles first, 3 = boundary tiles first
 int AXIS = 0; // 0 = off, 1 = on
 int ADVANCED_COLOUR = 1; // 0 = off, 1 = on
 
 int key; // Used in almost all functions to get keypresses
 
+// Orbit from the last trace in screen coordinates, so it can be erased without recomputing it
+int orbitX[MAX_ORBIT];
+int orbitY[MAX_ORBIT];
+int orbitLength = 0; // 0 = no trace on screen
+
 // Define structure for a complex number
 typedef struct
 {
@@ -58,25 +96,141 @@ typedef struct
     double im;
 } complex;
 
+// Define structure for a line drawn over the render, a single pixel is a line that starts where it ends
+typedef struct
+{
+    short x1;
+    short y1;
+    short x2;
+    short y2;
+    unsigned short color;
+    char layer;
+    short segment; // Which orbit segment a trace line is part of, -1 for anything else
+    int saved; // How many render pixels were saved before this line was drawn
+} overlayLine;
+
+// Lines drawn over the render, in the order they were drawn
+overlayLine overlay[OVERLAY_LINES];
+int overlayCount = 0;
+
+// Render pixels hidden by the overlay, kept as a stack so they can be put back without iterating them again
+unsigned short savedX[OVERLAY_PIXELS];
+unsigned char savedY[OVERLAY_PIXELS];
+unsigned short savedColor[OVERLAY_PIXELS];
+int savedCount = 0;
+
+// 1 bit per screen pixel, set if that pixel's render colour is on the stack above
+unsigned char overlayMask[SCREEN_PIXELS / 8];
+
+// Rows that have changed since the overlay was last flushed to the screen, top is below the screen when there are none
+int dirtyTop = HEIGHT + 1;
+int dirtyBottom = -1;
+
+// Point of the complex plane drawn at X_OFFSET, Y_OFFSET and pixels per unit, the host harness moves these to time other views
+complex viewPoint;
+float viewScale = ZOOM;
+
+// Estimated cost of each tile from the pre-pass, whether its samples disagree, and the order to render them in
+int tileCost[TILES_X * TILES_Y];
+char tileBoundary[TILES_X * TILES_Y];
+short tileOrder[TILES_X * TILES_Y];
+
+// Iteration counts of the last flythrough frame, the top bit marks pixels that differ from what resampling predicted
+unsigned char frame[ZOOM_HEIGHT][ZOOM_WIDTH];
+
+// The point the flythrough zooms into, in frame pixels and on the complex plane, and the zoom of the last frame
+int zoomX;
+int zoomY;
+complex zoomPoint;
+double zoomScale;
+
+// Where each column and row was in the last frame, the same every frame as the zoom point and factor never change
+short zoomX0[ZOOM_WIDTH];
+short zoomX1[ZOOM_WIDTH];
+short zoomY0[ZOOM_HEIGHT];
+short zoomY1[ZOOM_HEIGHT];
+
+// Ticks and cost of the first frame, which is computed exactly, used to price rendering later frames from scratch
+int firstTicks;
+int firstUnits;
+
+// Flythrough file and the bytes waiting to be written to or read from it
+unsigned short zoomName[32];
+int zoomFile;
+unsigned char stream[ZOOM_BUFFER];
+int streamLength = 0;
+int streamRead = 0; // Next byte of the buffer to read
+int streamHalf = -1; // Nibble waiting for the other half of its byte, -1 if there is none
+int streamPosition = 0; // Bytes streamed to the file so far
+int streamError = 0; // 1 if a write to the file failed
+
 // Function declarations
 void main();
 void editSettings();
 void getInfo();
 void drawAxis();
+int writeNumber(char *s, int number);
+int writeText(char *s, char *text);
+int ticksSince(int start);
 
 // Functions to do with rendering the Mandlebrot set
 void renderMandlebrot();
+int renderTiles(int *estimate);
 void mandlebrotPixel(unsigned int x, unsigned int y);
+int mandlebrotIterations(complex c);
 int getColor(int iterations, int maxIterations);
+int estimateTiles();
+void scheduleTiles();
+int tileBefore(int a, int b);
+void renderTile(int tile);
+void showProgress(int done, int total, int seconds);
 double squaredAbs(complex z);
 
 // Functions to do with the trace setting
 void setTrace();
 void drawTrace(unsigned int x, unsigned int y);
-
-// Functions used by the trace and axis settings above
-void Bdisp_DrawLine_VRAM(int x1, int y1, int x2, int y2, unsigned short color);
-void Bdisp_EraseLine_VRAM(int x1, int y1, int x2, int y2);
+void followTrace(unsigned int x, unsigned int y);
+int computeOrbit(unsigned int x, unsigned int y, int *px, int *py);
+void drawOrbit();
+void drawOrbitSegment(int i);
+void toggleAxis();
+
+// Functions used by the trace and axis settings above to draw over the render
+int overlayAdd(int x1, int y1, int x2, int y2, unsigned short color, int layer);
+void overlayRemove(int layer);
+void overlayClear();
+void overlayFlush();
+void overlayLift(int first);
+void overlayDraw(int i, int top, int bottom);
+void overlayPlot(int x, int y, unsigned short color, int top, int bottom);
+void markDirty(int y1, int y2);
+
+// Functions to do with the zoom flythrough
+void recordZoom();
+void playZoom();
+void startZoom();
+void firstFrame();
+int zoomStep(int number);
+int playStep();
+int openZoom();
+int closeZoom(int frames);
+int readZoomHeader(int *maxIterations);
+int zoomFrame(int record);
+int exactFrame();
+int checkFrame();
+int exactPixel(int x, int y);
+int frameUnits();
+void encodeFrame(int zoomed, int cost);
+void decodeFrame();
+void showFrame(int maxIterations);
+void showZoomStatus(char *name, int number, int percent);
+void streamByte(int byte);
+void streamNibble(int nibble);
+void streamCount(int count);
+void streamFlush();
+int readByte();
+int readNibble();
+int readCount();
 
 
 // Calculate the absolute value of a complex number, without sqrt as this is a slow function and we can square the other side instead
@@ -91,6 +245,18 @@ int modulo(int number, int denominator)
     return number - (denominator * (number/denominator));
 }
 
+// Count the ticks since start, allowing for the clock going back to 0 at midnight
+int ticksSince(int start)
+{
+    int ticks = RTC_GetTicks() - start;
+    if (ticks < 0)
+    {
+        ticks += TICKS_PER_DAY;
+    }
+
+    return ticks;
+}
+
 // Use iteration ratio to return an appropriate RGB 565 value
 int getColor(int iterations, int maxIterations)
 {
@@ -168,6 +334,10 @@ void editSettings()
     {
         PrintXY(1, 1, "  F1: Trace = On ", TEXT_MODE_NORMAL, TEXT_COLOR_BLACK);
     }
+    else if (TRACE == 2)
+    {
+        PrintXY(1, 1, "  F1: Trace = FOLLOW", TEXT_MODE_NORMAL, TEXT_COLOR_BLACK);
+    }
     
     // Prints appropriate iteration status
     PrintXY(1, 2, "  F2: Max Iters =   ", TEXT_MODE_NORMAL, TEXT_COLOR_BLACK);
@@ -187,6 +357,14 @@ void editSettings()
     {
         PrintXY(1, 3, "  F3: Live Rdr = ON ", TEXT_MODE_NORMAL, TEXT_COLOR_BLACK);
     }
+    else if (LIVE_RENDER == 2)
+    {
+        PrintXY(1, 3, "  F3: Live Rdr = CHEAP", TEXT_MODE_NORMAL, TEXT_COLOR_BLACK);
+    }
+    else if (LIVE_RENDER == 3)
+    {
+        PrintXY(1, 3, "  F3: Live Rdr = DETAIL", TEXT_MODE_NORMAL, TEXT_COLOR_BLACK);
+    }
 
     // Prints appropriate axis status
     if (AXIS == 0)
@@ -220,12 +398,17 @@ void editSettings()
         if (key == 0x7539 && TRACE == 0)
         {
             TRACE = 1;
-            PrintXY(1, 1, "  F1: Trace = ON ", TEXT_MODE_NORMAL, TEXT_COLOR_BLACK);
+            PrintXY(1, 1, "  F1: Trace = ON    ", TEXT_MODE_NORMAL, TEXT_COLOR_BLACK);
         }
         else if (key == 0x7539 && TRACE == 1)
+        {
+            TRACE = 2;
+            PrintXY(1, 1, "  F1: Trace = FOLLOW", TEXT_MODE_NORMAL, TEXT_COLOR_BLACK);
+        }
+        else if (key == 0x7539 && TRACE == 2)
         {
             TRACE = 0;
-            PrintXY(1, 1, "  F1: Trace = OFF", TEXT_MODE_NORMAL, TEXT_COLOR_BLACK);
+            PrintXY(1, 1, "  F1: Trace = OFF   ", TEXT_MODE_NORMAL, TEXT_COLOR_BLACK);
         }
 
 
@@ -273,12 +456,22 @@ void editSettings()
         else if (key == 0x753B && LIVE_RENDER == 0)
         {
             LIVE_RENDER = 1;
-            PrintXY(1, 3, "  F3: Live Rdr = ON ", TEXT_MODE_NORMAL, TEXT_COLOR_BLACK);
+            PrintXY(1, 3, "  F3: Live Rdr = ON    ", TEXT_MODE_NORMAL, TEXT_COLOR_BLACK);
         }
         else if (key == 0x753B && LIVE_RENDER == 1)
+        {
+            LIVE_RENDER = 2;
+            PrintXY(1, 3, "  F3: Live Rdr = CHEAP ", TEXT_MODE_NORMAL, TEXT_COLOR_BLACK);
+        }
+        else if (key == 0x753B && LIVE_RENDER == 2)
+        {
+            LIVE_RENDER = 3;
+            PrintXY(1, 3, "  F3: Live Rdr = DETAIL", TEXT_MODE_NORMAL, TEXT_COLOR_BLACK);
+        }
+        else if (key == 0x753B && LIVE_RENDER == 3)
         {
             LIVE_RENDER = 0;
-            PrintXY(1, 3, "  F3: Live Rdr = OFF", TEXT_MODE_NORMAL, TEXT_COLOR_BLACK);
+            PrintXY(1, 3, "  F3: Live Rdr = OFF   ", TEXT_MODE_NORMAL, TEXT_COLOR_BLACK);
         }
 
         // If key is F4
@@ -326,6 +519,9 @@ void renderMandlebrot()
 {
     Bdisp_EnableColor(ADVANCED_COLOUR);
 
+    // Forget anything drawn over the last render
+    overlayClear();
+
     //Clear VRAM ready to write to
     Bdisp_AllClr_VRAM();
 
@@ -344,37 +540,37 @@ void renderMandlebrot()
 
     Bdisp_PutDisp_DD();
 
-    // Iterate over each pixel on screen
-    for (unsigned int y = 24; y <= HEIGHT; y++)
-    {
-        for (unsigned int x = 0; x <= WIDTH; x++)
-        {
-            mandlebrotPixel(x, y);
-        }
-
-        // Make the loading icon move once
-        HourGlass();
-
-        if (LIVE_RENDER == 1)
-        {
-            // Force display VRAM strip
-            Bdisp_PutDisp_DD_stripe(y, y);
-        }
-    }
+    int estimate;
+    int ticks = renderTiles(&estimate);
+
+    // Leave how good the first estimate was in the status bar
+    char msg2[32];
+    int length = writeText(&msg2[0], "Est ");
+    length += writeNumber(&msg2[length], estimate / 128);
+    length += writeText(&msg2[length], "s took ");
+    length += writeNumber(&msg2[length], ticks / 128);
+    writeText(&msg2[length], "s");
+    DefineStatusMessage(&msg2[0], 0, TEXT_COLOR_BLACK, 0);
+    DisplayStatusArea();
 
     if (LIVE_RENDER == 0)
     {
         Bdisp_PutDisp_DD();
     }
+    else
+    {
+        Bdisp_PutDisp_DD_stripe(0, 23);
+    }
 
     // Draw axies
     if (AXIS == 1)
     {   
         drawAxis();
+        overlayFlush();
     }
     
     // Prepare cursor system for trace
-    if (TRACE == 1)
+    if (TRACE != 0)
     {
         setTrace();
     }
@@ -387,7 +583,179 @@ void renderMandlebrot()
         {
             main();
         }
+
+        // If key is F4, show or hide axies
+        else if (key == 0x753C)
+        {
+            toggleAxis();
+        }
+    }
+}
+
+// Render every tile in the order picked by the live render setting with a progress bar
+// Returns the ticks rendering took, and sets estimate to the ticks the pre-pass said it would take
+int renderTiles(int *estimate)
+{
+    // Time a sparse pass over every tile, so its cost can be turned into ticks before rendering starts
+    int start = RTC_GetTicks();
+    int sampled = estimateTiles();
+    int sampleTicks = ticksSince(start);
+    scheduleTiles();
+
+    int total = 0;
+    for (int i = 0; i < TILES_X * TILES_Y; i++)
+    {
+        total += tileCost[i];
+    }
+    *estimate = (long long)total * sampleTicks / sampled;
+
+    start = RTC_GetTicks();
+    int done = 0;
+    int bands = 0; // 1 bit for each band of tiles with new tiles in VRAM that are not on screen yet
+    for (int i = 0; i < TILES_X * TILES_Y; i++)
+    {
+        renderTile(tileOrder[i]);
+        done += tileCost[tileOrder[i]];
+        bands |= 1 << (tileOrder[i] / TILES_X);
+
+        // Redrawing the status bar is slow, so only update the screen every band's worth of tiles
+        // With live render on that is when each band is finished, so every band is flushed once
+        if (modulo(i + 1, TILES_X) != 0)
+        {
+            continue;
+        }
+
+        // Ticks per unit of cost so far, leaning on the pre-pass until enough tiles are done to measure it properly
+        int elapsed = ticksSince(start);
+        int remaining = (long long)(total - done) * (sampleTicks + elapsed) / (sampled + done);
+        showProgress(done, total, remaining / 128);
+
+        for (int band = 0; band < TILES_Y && LIVE_RENDER != 0; band++)
+        {
+            if (bands & (1 << band))
+            {
+                // Force display VRAM strip
+                int y = 24 + band * TILE_SIZE;
+                Bdisp_PutDisp_DD_stripe(y, y + TILE_SIZE - 1);
+            }
+        }
+        bands = 0;
+    }
+
+    return ticksSince(start);
+}
+
+// Iterate a sparse grid of samples in every tile to estimate what it will cost to render, returning the cost of the samples
+int estimateTiles()
+{
+    int sampled = 0;
+
+    for (int tile = 0; tile < TILES_X * TILES_Y; tile++)
+    {
+        int min = MAX_ITERATIONS;
+        int max = 0;
+        int sum = 0;
+
+        for (int j = 0; j < TILE_SAMPLES; j++)
+        {
+            for (int i = 0; i < TILE_SAMPLES; i++)
+            {
+                complex c;
+                int x = (tile % TILES_X) * TILE_SIZE + (2 * i + 1) * TILE_SIZE / (2 * TILE_SAMPLES);
+                int y = 24 + (tile / TILES_X) * TILE_SIZE + (2 * j + 1) * TILE_SIZE / (2 * TILE_SAMPLES);
+                c.re = viewPoint.re + (x - X_OFFSET) / viewScale;
+                c.im = viewPoint.im + (y - Y_OFFSET) / viewScale;
+
+                int iterations = mandlebrotIterations(c);
+                if (iterations < min)
+                {
+                    min = iterations;
+                }
+                if (iterations > max)
+                {
+                    max = iterations;
+                }
+                sum += iterations;
+            }
+        }
+
+        // Scale the samples up to the whole tile
+        tileCost[tile] = (sum + PIXEL_COST * TILE_SAMPLES * TILE_SAMPLES) * (TILE_SIZE * TILE_SIZE / (TILE_SAMPLES * TILE_SAMPLES));
+        tileBoundary[tile] = min != max;
+        sampled += sum + PIXEL_COST * TILE_SAMPLES * TILE_SAMPLES;
+    }
+
+    return sampled;
+}
+
+// Sort the tiles into the order picked by the live render setting
+void scheduleTiles()
+{
+    for (int i = 0; i < TILES_X * TILES_Y; i++)
+    {
+        int tile = i;
+        int j = i;
+
+        // Insertion sort keeps tiles that tie in reading order
+        while (j > 0 && tileBefore(tile, tileOrder[j - 1]))
+        {
+            tileOrder[j] = tileOrder[j - 1];
+            j--;
+        }
+        tileOrder[j] = tile;
+    }
+}
+
+// Whether tile a should be rendered before tile b
+int tileBefore(int a, int b)
+{
+    // Cheap tiles first, to cover the screen as fast as possible
+    if (LIVE_RENDER == 2)
+    {
+        return tileCost[a] < tileCost[b];
+    }
+
+    // Tiles on the boundary first, as that is where the detail is
+    else if (LIVE_RENDER == 3)
+    {
+        return tileBoundary[a] > tileBoundary[b];
+    }
+
+    return 0;
+}
+
+// Render every pixel in a tile
+void renderTile(int tile)
+{
+    int x0 = (tile % TILES_X) * TILE_SIZE;
+    int y0 = 24 + (tile / TILES_X) * TILE_SIZE;
+
+    for (int y = y0; y < y0 + TILE_SIZE; y++)
+    {
+        for (int x = x0; x < x0 + TILE_SIZE; x++)
+        {
+            mandlebrotPixel(x, y);
+        }
+    }
+}
+
+// Draw a progress bar along the bottom of the status bar, with the time left as its message
+void showProgress(int done, int total, int seconds)
+{
+    char msg[16];
+    int length = writeNumber(&msg[0], seconds);
+    writeText(&msg[length], "s left");
+    DefineStatusMessage(&msg[0], 0, TEXT_COLOR_BLACK, 0);
+    DisplayStatusArea();
+
+    int width = (long long)(WIDTH + 1) * done / total;
+    for (int x = 0; x < width; x++)
+    {
+        Bdisp_SetPoint_VRAM(x, 22, 0x001F);
+        Bdisp_SetPoint_VRAM(x, 23, 0x001F);
     }
+
+    Bdisp_PutDisp_DD_stripe(0, 23);
 }
 
 // Makes cursor that you can move around the screen and make a trace from
@@ -395,126 +763,216 @@ void setTrace()
 {
     int cx = X_OFFSET;
     int cy = Y_OFFSET;
-    unsigned short tmpcol = Bdisp_GetPoint_VRAM(cx, cy);
+
+    // Nothing from a previous render is still on screen
+    orbitLength = 0;
+
+    // In follow mode the orbit is always shown, starting from the origin
+    if (TRACE == 2)
+    {
+        followTrace(cx, cy);
+    }
 
     // Draw cursor at origin
-    Bdisp_SetPoint_VRAM(cx, cy, 0xf800);
+    overlayAdd(cx, cy, cx, cy, 0xf800, LAYER_CURSOR);
+    overlayFlush();
 
     while(1)
     {
         GetKey(&key);
 
-        // If up, move cursor up
-        if (key == 0x7542)
+        // If up, move cursor up, stopping at the status bar
+        if (key == 0x7542 && cy > 24)
         {
-            Bdisp_SetPoint_VRAM(cx, cy, tmpcol);
             cy--;
-            tmpcol = Bdisp_GetPoint_VRAM(cx, cy);
-            Bdisp_SetPoint_VRAM(cx, cy, 0xf800);
-            Bdisp_PutDisp_DD_stripe(cy, cy + 1);
         }
 
         // If right move cursor right
-        else if (key == 0x7545)
+        else if (key == 0x7545 && cx < WIDTH)
         {
-            Bdisp_SetPoint_VRAM(cx, cy, tmpcol);
             cx++;
-            tmpcol = Bdisp_GetPoint_VRAM(cx, cy);
-            Bdisp_SetPoint_VRAM(cx, cy, 0xf800);
-            Bdisp_PutDisp_DD_stripe(cy, cy);
         }
 
         // If down move cursor down
-        else if (key == 0x7547)
+        else if (key == 0x7547 && cy < HEIGHT)
         {
-            Bdisp_SetPoint_VRAM(cx, cy, tmpcol);
             cy++;
-            tmpcol = Bdisp_GetPoint_VRAM(cx, cy);
-            Bdisp_SetPoint_VRAM(cx, cy, 0xf800);
-            Bdisp_PutDisp_DD_stripe(cy - 1, cy);
         }
 
         // If left move cursor left
-        else if (key == 0x7544)
+        else if (key == 0x7544 && cx > 0)
         {
-            Bdisp_SetPoint_VRAM(cx, cy, tmpcol);
             cx--;
-            tmpcol = Bdisp_GetPoint_VRAM(cx, cy);
-            Bdisp_SetPoint_VRAM(cx, cy, 0xf800);
-            Bdisp_PutDisp_DD_stripe(cy, cy);
         }
 
-        // If exe, draw trace
-        else if (key == KEY_CTRL_EXE)
+        // If exe, draw trace (follow mode already has one drawn)
+        else if (key == KEY_CTRL_EXE && TRACE == 1)
         {
             drawTrace(cx, cy);
         }
 
+        // If key is F4, show or hide axies
+        else if (key == 0x753C)
+        {
+            toggleAxis();
+        }
+
         // If key is exit, return to menu
         else if (key == 0x7532)
         {
             main();
         }
+
+        // If the cursor moved or the axies changed, put the render back under the cursor and redraw it on top
+        if (key == 0x7542 || key == 0x7544 || key == 0x7545 || key == 0x7547 || key == 0x753C)
+        {
+            overlayRemove(LAYER_CURSOR);
+
+            // If following, redraw the orbit from its new position
+            if (TRACE == 2)
+            {
+                followTrace(cx, cy);
+            }
+
+            overlayAdd(cx, cy, cx, cy, 0xf800, LAYER_CURSOR);
+            overlayFlush();
+        }
     }
 }
 
-// Draws trace from point selected by cursor
-void drawTrace(unsigned int x, unsigned int y)
+// Fill px and py with the screen coordinates of a pixel's orbit, returning how many points it has
+int computeOrbit(unsigned int x, unsigned int y, int *px, int *py)
 {
     complex z1;
     complex z2;
     complex c;
-    int iterations = 0;
+    int length = 1;
 
     // Set Z to origin 
     z1.re = 0; 
     z1.im = 0;
+    px[0] = X_OFFSET;
+    py[0] = Y_OFFSET;
 
     c.re = (x - X_OFFSET) / ZOOM;
     c.im = (y - Y_OFFSET) / ZOOM;
 
-    while (iterations < MAX_ITERATIONS && squaredAbs(z1) <= 4)
+    while (length <= MAX_ITERATIONS && squaredAbs(z1) <= 4)
     {
         z2.re = (z1.re * z1.re) - (z1.im * z1.im) + c.re;
         z2.im = (2 * z1.re * z1.im) + c.im;
 
-        Bdisp_DrawLine_VRAM(z1.re * ZOOM + X_OFFSET, z1.im * ZOOM + Y_OFFSET, z2.re * ZOOM + X_OFFSET, z2.im * ZOOM + Y_OFFSET, 0x07e0);
-        Bdisp_SetPoint_VRAM(z1.re * ZOOM + X_OFFSET, z1.im * ZOOM + Y_OFFSET, 0xf800);
-        Bdisp_SetPoint_VRAM(z2.re * ZOOM + X_OFFSET, z2.im * ZOOM + Y_OFFSET, 0xf800);
+        px[length] = z2.re * ZOOM + X_OFFSET;
+        py[length] = z2.im * ZOOM + Y_OFFSET;
 
         z1 = z2;
-        iterations++;
+        length++;
     }
 
-    while(1)
+    // The first step from the origin always lands on c, so pin it to the cursor rather than risk rounding off by one
+    px[1] = x;
+    py[1] = y;
+
+    return length;
+}
+
+// Draw the cached orbit over the render
+void drawOrbit()
+{
+    for (int i = 0; i < orbitLength - 1; i++)
     {
-        GetKey(&key);
+        drawOrbitSegment(i);
+    }
+}
 
-        if ((key > 0x7542 && key < 0x7547) || key == KEY_CTRL_EXE)
+// Draw one segment of the cached orbit as a green line with red dots on both ends, so the dots stay on top whichever
+// segments get redrawn later
+void drawOrbitSegment(int i)
+{
+    int lines[3];
+    lines[0] = overlayAdd(orbitX[i], orbitY[i], orbitX[i + 1], orbitY[i + 1], 0x07e0, LAYER_TRACE);
+    lines[1] = overlayAdd(orbitX[i], orbitY[i], orbitX[i], orbitY[i], 0xf800, LAYER_TRACE);
+    lines[2] = overlayAdd(orbitX[i + 1], orbitY[i + 1], orbitX[i + 1], orbitY[i + 1], 0xf800, LAYER_TRACE);
+
+    for (int j = 0; j < 3; j++)
+    {
+        if (lines[j] >= 0)
         {
-            z1.re = 0; 
-            z1.im = 0;
-            iterations = 0;
+            overlay[lines[j]].segment = i;
+        }
+    }
+}
 
-            c.re = (x - X_OFFSET) / ZOOM;
-            c.im = (y - Y_OFFSET) / ZOOM;
+// Moves the cached orbit to a new pixel, only taking off and redrawing the segments whose endpoints moved
+void followTrace(unsigned int x, unsigned int y)
+{
+    int newX[MAX_ORBIT];
+    int newY[MAX_ORBIT];
+    int newLength = computeOrbit(x, y, newX, newY);
+
+    // The second point is always the cursor so the first two segments always move, but where the orbit settles down
+    // the rest of it often lands on the same pixels
+    char moved[MAX_ORBIT];
+    for (int i = 0; i < MAX_ORBIT - 1; i++)
+    {
+        moved[i] = i >= orbitLength - 1 || i >= newLength - 1 || orbitX[i] != newX[i] || orbitY[i] != newY[i] || orbitX[i + 1] != newX[i + 1] || orbitY[i + 1] != newY[i + 1];
+    }
 
-            while (iterations < MAX_ITERATIONS && squaredAbs(z1) <= 4)
-            {
-                z2.re = (z1.re * z1.re) - (z1.im * z1.im) + c.re;
-                z2.im = (2 * z1.re * z1.im) + c.im;
+    for (int i = 0; i < overlayCount; i++)
+    {
+        if (overlay[i].layer == LAYER_TRACE && moved[overlay[i].segment])
+        {
+            overlay[i].layer = LAYER_MOVED;
+        }
+    }
+    overlayRemove(LAYER_MOVED);
 
-                Bdisp_EraseLine_VRAM(z1.re * ZOOM + X_OFFSET, z1.im * ZOOM + Y_OFFSET, z2.re * ZOOM + X_OFFSET, z2.im * ZOOM + Y_OFFSET);
+    for (int i = 0; i < newLength; i++)
+    {
+        orbitX[i] = newX[i];
+        orbitY[i] = newY[i];
+    }
+    orbitLength = newLength;
 
-                z1 = z2;
-                iterations++;
-            }
+    // Segments that stayed put sink below the ones that keep moving, so later moves have less to lift off
+    for (int i = 0; i < orbitLength - 1; i++)
+    {
+        if (moved[i])
+        {
+            drawOrbitSegment(i);
+        }
+    }
+}
 
-            Bdisp_SetPoint_VRAM(x, y, 0xf800);
+// Draws trace from point selected by cursor
+void drawTrace(unsigned int x, unsigned int y)
+{
+    orbitLength = computeOrbit(x, y, orbitX, orbitY);
+    drawOrbit();
+
+    while(1)
+    {
+        GetKey(&key);
+
+        if ((key > 0x7542 && key < 0x7547) || key == KEY_CTRL_EXE)
+        {
+            // Put back the render from under the trace, leaving the cursor and axies
+            overlayRemove(LAYER_TRACE);
+            overlayFlush();
+            orbitLength = 0;
 
             return;
         }
 
+        // If key is F4, show or hide axies under the trace, then put the cursor back on top of them
+        else if (key == 0x753C)
+        {
+            toggleAxis();
+            overlayRemove(LAYER_CURSOR);
+            overlayAdd(x, y, x, y, 0xf800, LAYER_CURSOR);
+            overlayFlush();
+        }
+
         else if (key == 0x7532)
         {
             main();
@@ -522,34 +980,65 @@ void drawTrace(unsigned int x, unsigned int y)
     }
 }
 
+// Show or hide the axies without touching the render underneath them
+void toggleAxis()
+{
+    if (AXIS == 0)
+    {
+        AXIS = 1;
+        drawAxis();
+    }
+    else
+    {
+        AXIS = 0;
+        overlayRemove(LAYER_AXIS);
+    }
+
+    overlayFlush();
+}
+
 // Draws fully scaled axies over the top of a render
 void drawAxis()
 {
     // Draw Axis Lines
-    Bdisp_DrawLine_VRAM(0, Y_OFFSET, WIDTH, Y_OFFSET, 0xFFFF);
-    Bdisp_DrawLine_VRAM(X_OFFSET, 0, X_OFFSET, HEIGHT, 0xFFFF);
+    overlayAdd(0, Y_OFFSET, WIDTH, Y_OFFSET, 0xFFFF, LAYER_AXIS);
+    overlayAdd(X_OFFSET, 0, X_OFFSET, HEIGHT, 0xFFFF, LAYER_AXIS);
 
     // Draw Origin
-    Bdisp_DrawLine_VRAM(X_OFFSET - 1, Y_OFFSET + 1, X_OFFSET + 1, Y_OFFSET + 1, 0xFFFF);
-    Bdisp_DrawLine_VRAM(X_OFFSET - 1, Y_OFFSET - 1, X_OFFSET + 1, Y_OFFSET - 1, 0xFFFF);
+    overlayAdd(X_OFFSET - 1, Y_OFFSET + 1, X_OFFSET + 1, Y_OFFSET + 1, 0xFFFF, LAYER_AXIS);
+    overlayAdd(X_OFFSET - 1, Y_OFFSET - 1, X_OFFSET + 1, Y_OFFSET - 1, 0xFFFF, LAYER_AXIS);
 
     // Draw unit increments
     for (int i = -1; i <= 1; i++)
     {
-        Bdisp_DrawLine_VRAM(X_OFFSET - 3, Y_OFFSET + i * ZOOM, X_OFFSET + 3, Y_OFFSET + i * ZOOM, 0xFFFF);
-        Bdisp_DrawLine_VRAM(X_OFFSET + i * ZOOM, Y_OFFSET - 3, X_OFFSET + i * ZOOM, Y_OFFSET + 3, 0xFFFF);
-        Bdisp_DrawLine_VRAM(X_OFFSET - 2, Y_OFFSET + i * ZOOM - 0.5 * ZOOM, X_OFFSET + 2, Y_OFFSET + i * ZOOM - 0.5 * ZOOM, 0xFFFF);
-        Bdisp_DrawLine_VRAM(X_OFFSET + i * ZOOM - 0.5 * ZOOM, Y_OFFSET - 2, X_OFFSET + i * ZOOM - 0.5 * ZOOM, Y_OFFSET + 2, 0xFFFF);
+        overlayAdd(X_OFFSET - 3, Y_OFFSET + i * ZOOM, X_OFFSET + 3, Y_OFFSET + i * ZOOM, 0xFFFF, LAYER_AXIS);
+        overlayAdd(X_OFFSET + i * ZOOM, Y_OFFSET - 3, X_OFFSET + i * ZOOM, Y_OFFSET + 3, 0xFFFF, LAYER_AXIS);
+        overlayAdd(X_OFFSET - 2, Y_OFFSET + i * ZOOM - 0.5 * ZOOM, X_OFFSET + 2, Y_OFFSET + i * ZOOM - 0.5 * ZOOM, 0xFFFF, LAYER_AXIS);
+        overlayAdd(X_OFFSET + i * ZOOM - 0.5 * ZOOM, Y_OFFSET - 2, X_OFFSET + i * ZOOM - 0.5 * ZOOM, Y_OFFSET + 2, 0xFFFF, LAYER_AXIS);
     }
-    Bdisp_DrawLine_VRAM(X_OFFSET - 2 * ZOOM, Y_OFFSET - 3, X_OFFSET - 2 * ZOOM, Y_OFFSET + 3, 0xFFFF);
-    Bdisp_DrawLine_VRAM(X_OFFSET - 2 * ZOOM - 0.5 * ZOOM, Y_OFFSET - 2, X_OFFSET - 2 * ZOOM - 0.5 * ZOOM, Y_OFFSET + 2, 0xFFFF);
+    overlayAdd(X_OFFSET - 2 * ZOOM, Y_OFFSET - 3, X_OFFSET - 2 * ZOOM, Y_OFFSET + 3, 0xFFFF, LAYER_AXIS);
+    overlayAdd(X_OFFSET - 2 * ZOOM - 0.5 * ZOOM, Y_OFFSET - 2, X_OFFSET - 2 * ZOOM - 0.5 * ZOOM, Y_OFFSET + 2, 0xFFFF, LAYER_AXIS);
 }
 
 // Draw the correct colour of a pixel of the mandlebrot set given pixel coords
 void mandlebrotPixel(unsigned int x, unsigned int y)
 {
-    complex z;
     complex c;
+
+    // Set parameter to pixel
+    c.re = viewPoint.re + (x - X_OFFSET) / viewScale;
+    c.im = viewPoint.im + (y - Y_OFFSET) / viewScale;
+
+    //Colour each pixel
+    Bdisp_SetPoint_VRAM(x, y, getColor(mandlebrotIterations(c), MAX_ITERATIONS));
+
+    return;
+}
+
+// Count how many iterations it takes a point to escape, up to MAX_ITERATIONS
+int mandlebrotIterations(complex c)
+{
+    complex z;
     complex tmp;
     int iterations = 0;   
 
@@ -557,10 +1046,6 @@ void mandlebrotPixel(unsigned int x, unsigned int y)
     z.re = 0; 
     z.im = 0;
 
-    // Set parameter to pixel
-    c.re = (x - X_OFFSET) / ZOOM;
-    c.im = (y - Y_OFFSET) / ZOOM;
-
     while (iterations < MAX_ITERATIONS && squaredAbs(z) <= 4)
     {
         //Perform Z_(n+1) = Z_(n)^2 + c
@@ -572,115 +1057,1089 @@ void mandlebrotPixel(unsigned int x, unsigned int y)
         iterations++;
     }
 
-    //Colour each pixel
-    Bdisp_SetPoint_VRAM(x, y, getColor(iterations, MAX_ITERATIONS));
-
-    return;
+    return iterations;
 }
 
-void main(void) 
+// Record a zoom flythrough into a point picked on the first frame, streaming each frame to storage as it is made
+void recordZoom()
 {
-    //Clear VRAM ready to write to
-    Bdisp_AllClr_VRAM();
-
-    // Bypass 3 bit 8 colour mode
     Bdisp_EnableColor(ADVANCED_COLOUR);
+    overlayClear();
+    Bdisp_AllClr_VRAM();
 
     // Setup header
     char color1 = TEXT_COLOR_WHITE;
     char color2 = TEXT_COLOR_WHITE;
-    char msg[5] = "Menu";
+    char msg[10] = "Pick zoom";
     DefineStatusMessage(&msg[0], 0, TEXT_COLOR_BLACK, 0);
     DefineStatusAreaFlags(4, SAF_BATTERY | SAF_TEXT | SAF_ALPHA_SHIFT, &color1, &color2);
-    EnableDisplayHeader(2, 2);
+    DisplayStatusArea();
 
-    PrintXY(1, 1, "  F1: Mandelbrot", TEXT_MODE_NORMAL, TEXT_COLOR_BLACK);
-    PrintXY(1, 8, "  F6: Settings ->", TEXT_MODE_NORMAL, TEXT_COLOR_BLACK);
+    // The first frame is the normal view, whichever point it zooms into
+    zoomX = X_OFFSET;
+    zoomY = Y_OFFSET - 24;
+    startZoom();
+    firstFrame();
+    showFrame(MAX_ITERATIONS);
 
+    // Move the cursor to the point to zoom into, then press EXE
+    overlayAdd(zoomX, zoomY + 24, zoomX, zoomY + 24, 0xf800, LAYER_CURSOR);
+    overlayFlush();
     while(1)
     {
         GetKey(&key);
 
-        // If key is F1, render mandelbrot
-        if (key == 0x7539)
+        if (key == 0x7542 && zoomY > 0)
         {
-            renderMandlebrot();
+            zoomY--;
         }
-
-        // If key is F6, render mandlebrot
-        else if (key == 0x753E|| key == 0x7545)
+        else if (key == 0x7545 && zoomX < ZOOM_WIDTH - 1)
         {
-            editSettings();
+            zoomX++;
         }
-
-        // This should never be pressed, but if they do then this will force quit
-        else if (key == KEY_CTRL_EXE) 
+        else if (key == 0x7547 && zoomY < ZOOM_HEIGHT - 1)
+        {
+            zoomY++;
+        }
+        else if (key == 0x7544 && zoomX > 0)
+        {
+            zoomX--;
+        }
+        else if (key == KEY_CTRL_EXE)
         {
             break;
         }
-    }
-    return; // Main can never return, so this call should never be reached
-}
+        else if (key == 0x7532)
+        {
+            main();
+        }
 
-// A function I modified from here https://prizm.cemetech.net/Useful_Routines/DrawLine/ by Christopher Mitchell
-void Bdisp_DrawLine_VRAM(int x1, int y1, int x2, int y2, unsigned short color) 
-{
-    signed char ix;
-    signed char iy;
+        overlayRemove(LAYER_CURSOR);
+        overlayAdd(zoomX, zoomY + 24, zoomX, zoomY + 24, 0xf800, LAYER_CURSOR);
+        overlayFlush();
+    }
+    overlayClear();
+    startZoom();
 
-    int delta_x = (x2 > x1?(ix = 1, x2 - x1):(ix = -1, x1 - x2)) << 1;
-    int delta_y = (y2 > y1?(iy = 1, y2 - y1):(iy = -1, y1 - y2)) << 1;
- 
-    Bdisp_SetPoint_VRAM(x1, y1, color); 
-    if (delta_x >= delta_y) 
+    int frames = 0;
+    int full = 0;
+    if (openZoom() == 0)
     {
-        int error = delta_y - (delta_x >> 1);        
-        while (x1 != x2) 
+        showZoomStatus("Can't save zoom", 0, -1);
+    }
+    else
+    {
+        encodeFrame(0, 1000);
+        frames = 1;
+        int costs = 0;
+
+        for (int i = 1; i <= ZOOM_FRAMES; i++)
         {
-            if (error >= 0) 
+            int cost = zoomStep(i);
+            if (streamPosition + streamLength > ZOOM_FILE_SIZE)
             {
-                if (error || (ix > 0)) 
-                {
-                    y1 += iy;
-                    error -= delta_x;
-                }                           
+                full = 1;
+                break;
             }
-                                          
-        x1 += ix;
-        error += delta_y;
-        Bdisp_SetPoint_VRAM(x1, y1, color);   
+            frames++;
+            costs += cost;
+
+            showZoomStatus("Zoom ", i, cost / 10);
+            showFrame(MAX_ITERATIONS);
         }
-    } 
-    else 
+
+        // Only offer an exact pass over the last frame if the file is sure to have room for it
+        if (full == 1 || streamPosition + streamLength + ZOOM_FRAME_MAX > ZOOM_FILE_SIZE)
+        {
+            full = 1;
+            showZoomStatus("File full avg ", 0, frames > 1 ? costs / ((frames - 1) * 10) : 100);
+        }
+        else
+        {
+            showZoomStatus("EXE:Exact avg ", 0, frames > 1 ? costs / ((frames - 1) * 10) : 100);
+        }
+        Bdisp_PutDisp_DD_stripe(0, 23);
+
+        while(full == 0)
+        {
+            GetKey(&key);
+
+            if (key == KEY_CTRL_EXE)
+            {
+                exactFrame();
+                encodeFrame(0, 1000);
+                frames++;
+
+                showFrame(MAX_ITERATIONS);
+                break;
+            }
+            else if (key == 0x7532)
+            {
+                break;
+            }
+        }
+
+        if (closeZoom(frames) == 0)
+        {
+            showZoomStatus("Can't save zoom", 0, -1);
+        }
+        else if (full == 1)
+        {
+            showZoomStatus("File full, saved ", frames, -1);
+        }
+        else
+        {
+            showZoomStatus("Saved ", frames, -1);
+        }
+    }
+    Bdisp_PutDisp_DD_stripe(0, 23);
+
+    // Exit back to main menu
+    while(1)
     {
-        int error = delta_x - (delta_y >> 1);      
-        while (y1 != y2) 
+        GetKey(&key);
+        if (key == 0x7532)
         {
-            if (error >= 0) 
+            main();
+        }
+    }
+}
+
+// Play back the last recorded flythrough by resampling each frame from the one before and applying its changes
+void playZoom()
+{
+    Bdisp_EnableColor(ADVANCED_COLOUR);
+    overlayClear();
+    Bdisp_AllClr_VRAM();
+
+    // Setup header
+    char color1 = TEXT_COLOR_WHITE;
+    char color2 = TEXT_COLOR_WHITE;
+    char msg[5] = "Play";
+    DefineStatusMessage(&msg[0], 0, TEXT_COLOR_BLACK, 0);
+    DefineStatusAreaFlags(4, SAF_BATTERY | SAF_TEXT | SAF_ALPHA_SHIFT, &color1, &color2);
+    DisplayStatusArea();
+
+    int maxIterations;
+    int frames = readZoomHeader(&maxIterations);
+
+    if (frames == 0)
+    {
+        PrintXY(1, 4, "  No zoom recorded", TEXT_MODE_NORMAL, TEXT_COLOR_BLACK);
+        Bdisp_PutDisp_DD();
+    }
+
+    for (int i = 0; i < frames; i++)
+    {
+        int cost = playStep();
+
+        showZoomStatus("Play ", i + 1, cost / 10);
+        showFrame(maxIterations);
+    }
+
+    if (zoomFile >= 0)
+    {
+        Bfile_CloseFile_OS(zoomFile);
+    }
+
+    // Exit back to main menu
+    while(1)
+    {
+        GetKey(&key);
+        if (key == 0x7532)
+        {
+            main();
+        }
+    }
+}
+
+// Set up the first frame's view around the zoom point, and where each pixel of a frame comes from in the one before
+void startZoom()
+{
+    zoomPoint.re = (zoomX - X_OFFSET) / ZOOM;
+    zoomPoint.im = (zoomY + 24 - Y_OFFSET) / ZOOM;
+    zoomScale = ZOOM;
+
+    // Both are positive so casting rounds down
+    for (int x = 0; x < ZOOM_WIDTH; x++)
+    {
+        double fx = zoomX + (x - zoomX) / ZOOM_FACTOR;
+        zoomX0[x] = fx;
+        zoomX1[x] = (fx > zoomX0[x] && zoomX0[x] < ZOOM_WIDTH - 1) ? zoomX0[x] + 1 : zoomX0[x];
+    }
+
+    for (int y = 0; y < ZOOM_HEIGHT; y++)
+    {
+        double fy = zoomY + (y - zoomY) / ZOOM_FACTOR;
+        zoomY0[y] = fy;
+        zoomY1[y] = (fy > zoomY0[y] && zoomY0[y] < ZOOM_HEIGHT - 1) ? zoomY0[y] + 1 : zoomY0[y];
+    }
+}
+
+// Compute the first frame exactly on top of an empty one, timing it as the first full render to compare against
+void firstFrame()
+{
+    for (int y = 0; y < ZOOM_HEIGHT; y++)
+    {
+        for (int x = 0; x < ZOOM_WIDTH; x++)
+        {
+            frame[y][x] = 0;
+        }
+    }
+
+    int start = RTC_GetTicks();
+    exactFrame();
+    firstTicks = ticksSince(start);
+    firstUnits = frameUnits();
+}
+
+// Make and stream the next frame of a recording, returning its ticks per 1000 that renderMandlebrot() would take for it
+int zoomStep(int number)
+{
+    int start = RTC_GetTicks();
+    zoomScale *= ZOOM_FACTOR;
+
+    zoomFrame(1);
+    if (modulo(number, ZOOM_CHECK_FRAMES) == 0)
+    {
+        checkFrame();
+    }
+    int ticks = ticksSince(start);
+
+    // A full render costs about the same per unit as the first frame did
+    int independent = (long long)firstTicks * frameUnits() / firstUnits;
+    int cost = 1000;
+    if (independent > 0)
+    {
+        cost = (long long)ticks * 1000 / independent;
+    }
+    if (cost > 0xFFFF)
+    {
+        cost = 0xFFFF;
+    }
+
+    encodeFrame(1, cost);
+    return cost;
+}
+
+// Read and apply the next frame of a recording, returning its cost
+int playStep()
+{
+    int zoomed = readByte();
+    int cost = readByte() << 8;
+    cost |= readByte();
+
+    if (zoomed == 1)
+    {
+        zoomFrame(0);
+    }
+    decodeFrame();
+
+    return cost;
+}
+
+// Create the flythrough file and leave room for its header, returning 0 if it could not be made
+int openZoom()
+{
+    Bfile_StrToName_ncpy(zoomName, ZOOM_FILE, 32);
+    Bfile_DeleteEntry(zoomName);
+
+    size_t size = ZOOM_FILE_SIZE;
+    if (Bfile_CreateEntry_OS(zoomName, CREATEMODE_FILE, &size) < 0)
+    {
+        return 0;
+    }
+
+    zoomFile = Bfile_OpenFile_OS(zoomName, READWRITE, 0);
+    if (zoomFile < 0)
+    {
+        return 0;
+    }
+
+    streamLength = 0;
+    streamPosition = 0;
+    streamError = 0;
+    streamHalf = -1;
+
+    // The header is filled in once the number of frames is known
+    for (int i = 0; i < 8; i++)
+    {
+        streamByte(0);
+    }
+
+    return 1;
+}
+
+// Write out the rest of the flythrough file and its header, returning 0 if anything failed to save
+int closeZoom(int frames)
+{
+    // The file system only takes whole 2 byte words
+    if (streamLength & 1)
+    {
+        streamByte(0);
+    }
+    streamFlush();
+
+    unsigned char header[8];
+    header[0] = 'Z';
+    header[1] = 'M';
+    header[2] = frames;
+    header[3] = MAX_ITERATIONS;
+    header[4] = zoomX >> 8;
+    header[5] = zoomX & 0xFF;
+    header[6] = zoomY;
+    header[7] = ZOOM_FACTOR * 100;
+    if (Bfile_SeekFile_OS(zoomFile, 0) < 0 || Bfile_WriteFile_OS(zoomFile, header, 8) < 0)
+    {
+        streamError = 1;
+    }
+    Bfile_CloseFile_OS(zoomFile);
+
+    return streamError == 0;
+}
+
+// Open the flythrough file and read its header, which is also the script to replay it from
+// Returns how many frames it has, 0 if there is no recording
+int readZoomHeader(int *maxIterations)
+{
+    Bfile_StrToName_ncpy(zoomName, ZOOM_FILE, 32);
+    zoomFile = Bfile_OpenFile_OS(zoomName, READ, 0);
+    streamLength = 0;
+    streamRead = 0;
+    streamHalf = -1;
+
+    if (zoomFile < 0)
+    {
+        return 0;
+    }
+
+    if (readByte() != 'Z' || readByte() != 'M')
+    {
+        return 0;
+    }
+
+    int frames = readByte();
+    *maxIterations = readByte();
+    zoomX = readByte() << 8;
+    zoomX |= readByte();
+    zoomY = readByte();
+
+    if (readByte() != ZOOM_FACTOR * 100 || zoomX >= ZOOM_WIDTH || zoomY >= ZOOM_HEIGHT)
+    {
+        return 0;
+    }
+
+    startZoom();
+    for (int y = 0; y < ZOOM_HEIGHT; y++)
+    {
+        for (int x = 0; x < ZOOM_WIDTH; x++)
+        {
+            frame[y][x] = 0;
+        }
+    }
+
+    return frames;
+}
+
+// Make the next flythrough frame, one ZOOM_FACTOR deeper, by resampling the last one in place around the zoom point
+// When recording, pixels whose neighbours in the last frame disagree are computed exactly
+// Returns how many pixels were computed
+int zoomFrame(int record)
+{
+    int computed = 0;
+
+    // Work in from the edges, as every pixel is resampled from ones nearer the zoom point that have not been overwritten yet
+    for (int dy = ZOOM_HEIGHT - 1; dy >= 0; dy--)
+    {
+        for (int sy = -1; sy <= 1; sy += 2)
+        {
+            int y = zoomY + sy * dy;
+            if (y < 0 || y >= ZOOM_HEIGHT || (dy == 0 && sy == 1))
             {
-                if (error || (iy > 0)) 
+                continue;
+            }
+
+            unsigned char *row0 = frame[zoomY0[y]];
+            unsigned char *row1 = frame[zoomY1[y]];
+
+            for (int dx = ZOOM_WIDTH - 1; dx >= 0; dx--)
+            {
+                for (int sx = -1; sx <= 1; sx += 2)
                 {
-                    x1 += ix;
-                    error -= delta_y;
-                }                           
-            }                              
-        y1 += iy;
-        error += delta_x;  
-        Bdisp_SetPoint_VRAM(x1, y1, color);
+                    int x = zoomX + sx * dx;
+                    if (x < 0 || x >= ZOOM_WIDTH || (dx == 0 && sx == 1))
+                    {
+                        continue;
+                    }
+
+                    int x0 = zoomX0[x];
+                    int x1 = zoomX1[x];
+                    int prediction = row0[x0] & 0x7F;
+
+                    if (record == 0)
+                    {
+                        frame[y][x] = prediction;
+                    }
+
+                    // If the surrounding pixels all agree there is no new detail here to compute
+                    else if ((row0[x1] & 0x7F) == prediction && (row1[x0] & 0x7F) == prediction && (row1[x1] & 0x7F) == prediction)
+                    {
+                        frame[y][x] = prediction;
+                    }
+
+                    else
+                    {
+                        complex c;
+                        c.re = zoomPoint.re + (x - zoomX) / zoomScale;
+                        c.im = zoomPoint.im + (y - zoomY) / zoomScale;
+
+                        int iterations = mandlebrotIterations(c);
+                        frame[y][x] = iterations | (iterations != prediction ? 0x80 : 0);
+                        computed++;
+                    }
+                }
+            }
+        }
+    }
+
+    return computed;
+}
+
+// Compute every pixel of the current flythrough frame exactly, marking the ones that changed
+int exactFrame()
+{
+    int computed = 0;
+
+    for (int y = 0; y < ZOOM_HEIGHT; y++)
+    {
+        for (int x = 0; x < ZOOM_WIDTH; x++)
+        {
+            complex c;
+            c.re = zoomPoint.re + (x - zoomX) / zoomScale;
+            c.im = zoomPoint.im + (y - zoomY) / zoomScale;
+
+            int iterations = mandlebrotIterations(c);
+            frame[y][x] = iterations | (iterations != (frame[y][x] & 0x7F) ? 0x80 : 0);
+            computed += iterations;
+        }
+    }
+
+    return computed;
+}
+
+// Resampling only computes pixels whose neighbours disagree, so detail that appears inside an even area is missed
+// Check one pixel in every block exactly, and where it is wrong compute the whole block, carrying on into the blocks
+// next to it for as long as their shared edge keeps changing
+// Returns how many pixels were computed
+int checkFrame()
+{
+    char queued[CHECK_Y][CHECK_X];
+    short queue[CHECK_X * CHECK_Y];
+    int length = 0;
+    int computed = 0;
+
+    for (int by = 0; by < CHECK_Y; by++)
+    {
+        for (int bx = 0; bx < CHECK_X; bx++)
+        {
+            queued[by][bx] = exactPixel(bx * ZOOM_CHECK + ZOOM_CHECK / 2, by * ZOOM_CHECK + ZOOM_CHECK / 2);
+            computed++;
+
+            if (queued[by][bx])
+            {
+                queue[length] = by * CHECK_X + bx;
+                length++;
+            }
+        }
+    }
+
+    while (length > 0)
+    {
+        length--;
+        int bx = modulo(queue[length], CHECK_X);
+        int by = queue[length] / CHECK_X;
+        int x0 = bx * ZOOM_CHECK;
+        int y0 = by * ZOOM_CHECK;
+
+        // Which edges of the block changed, left, right, top and bottom
+        int edges[4] = {0, 0, 0, 0};
+        for (int y = y0; y < y0 + ZOOM_CHECK; y++)
+        {
+            for (int x = x0; x < x0 + ZOOM_CHECK; x++)
+            {
+                if (exactPixel(x, y))
+                {
+                    edges[0] |= x == x0;
+                    edges[1] |= x == x0 + ZOOM_CHECK - 1;
+                    edges[2] |= y == y0;
+                    edges[3] |= y == y0 + ZOOM_CHECK - 1;
+                }
+                computed++;
+            }
+        }
+
+        int nextX[4] = {bx - 1, bx + 1, bx, bx};
+        int nextY[4] = {by, by, by - 1, by + 1};
+        for (int i = 0; i < 4; i++)
+        {
+            if (edges[i] && nextX[i] >= 0 && nextX[i] < CHECK_X && nextY[i] >= 0 && nextY[i] < CHECK_Y && queued[nextY[i]][nextX[i]] == 0)
+            {
+                queued[nextY[i]][nextX[i]] = 1;
+                queue[length] = nextY[i] * CHECK_X + nextX[i];
+                length++;
+            }
+        }
+    }
+
+    return computed;
+}
+
+// Compute one pixel of the current frame exactly, marking it and returning 1 if that changed it
+int exactPixel(int x, int y)
+{
+    complex c;
+    c.re = zoomPoint.re + (x - zoomX) / zoomScale;
+    c.im = zoomPoint.im + (y - zoomY) / zoomScale;
+
+    int iterations = mandlebrotIterations(c);
+    if (iterations == (frame[y][x] & 0x7F))
+    {
+        return 0;
+    }
+
+    frame[y][x] = iterations | 0x80;
+    return 1;
+}
+
+// Add up the cost of rendering the current frame from scratch, in the same units as the tile pre-pass
+int frameUnits()
+{
+    int units = 0;
+
+    for (int y = 0; y < ZOOM_HEIGHT; y++)
+    {
+        for (int x = 0; x < ZOOM_WIDTH; x++)
+        {
+            units += (frame[y][x] & 0x7F) + PIXEL_COST;
+        }
+    }
+
+    return units;
+}
+
+// Stream the marked pixels of a frame as runs of unchanged count, changed count and changed values, clearing the marks
+// Runs are mostly short and values mostly close to the pixel before them, so both are packed into nibbles where they fit
+void encodeFrame(int zoomed, int cost)
+{
+    unsigned char *pixels = &frame[0][0];
+    int i = 0;
+
+    streamByte(zoomed);
+    streamByte(cost >> 8);
+    streamByte(cost & 0xFF);
+
+    while (i < ZOOM_WIDTH * ZOOM_HEIGHT)
+    {
+        int skip = 0;
+        while (skip < 255 && i + skip < ZOOM_WIDTH * ZOOM_HEIGHT && (pixels[i + skip] & 0x80) == 0)
+        {
+            skip++;
+        }
+        i += skip;
+
+        int count = 0;
+        while (count < 255 && i + count < ZOOM_WIDTH * ZOOM_HEIGHT && (pixels[i + count] & 0x80) != 0)
+        {
+            count++;
+        }
+
+        streamCount(skip);
+        streamCount(count);
+        for (int j = 0; j < count; j++)
+        {
+            pixels[i] &= 0x7F;
+
+            // 0 to 14 is a change of -7 to 7 from the pixel before, 15 means the value follows in full
+            int change = pixels[i] - (i > 0 ? pixels[i - 1] & 0x7F : 0);
+            if (change >= -7 && change <= 7)
+            {
+                streamNibble(change + 7);
+            }
+            else
+            {
+                streamNibble(15);
+                streamNibble(pixels[i] >> 4);
+                streamNibble(pixels[i] & 0xF);
+            }
+            i++;
+        }
+    }
+
+    // Frames start on a whole byte
+    if (streamHalf >= 0)
+    {
+        streamNibble(0);
+    }
+}
+
+// Apply the runs of changed pixels streamed by encodeFrame() to the current frame
+void decodeFrame()
+{
+    unsigned char *pixels = &frame[0][0];
+    int i = 0;
+    streamHalf = -1;
+
+    while (i < ZOOM_WIDTH * ZOOM_HEIGHT)
+    {
+        int skip = readCount();
+        int count = readCount();
+
+        // The encoder never writes an empty run, so the file must have ended early
+        if ((skip == 0 && count == 0) || i + skip + count > ZOOM_WIDTH * ZOOM_HEIGHT)
+        {
+            return;
         }
+
+        i += skip;
+        for (int j = 0; j < count; j++)
+        {
+            int change = readNibble();
+            if (change == 15)
+            {
+                pixels[i] = readNibble() << 4;
+                pixels[i] |= readNibble();
+            }
+            else
+            {
+                pixels[i] = (i > 0 ? pixels[i - 1] & 0x7F : 0) + change - 7;
+            }
+            i++;
+        }
+    }
+}
+
+// Draw the current flythrough frame under the status bar
+void showFrame(int maxIterations)
+{
+    for (int y = 0; y < ZOOM_HEIGHT; y++)
+    {
+        for (int x = 0; x < ZOOM_WIDTH; x++)
+        {
+            Bdisp_SetPoint_VRAM(x, y + 24, getColor(frame[y][x] & 0x7F, maxIterations));
+        }
+    }
+
+    Bdisp_PutDisp_DD();
+}
+
+// Show a message followed by a number and a percentage in the status bar, a negative percentage is left off
+void showZoomStatus(char *name, int number, int percent)
+{
+    char msg[32];
+    int length = writeText(&msg[0], name);
+
+    if (number > 0)
+    {
+        length += writeNumber(&msg[length], number);
+        msg[length] = ' ';
+        length++;
+    }
+
+    if (percent >= 0)
+    {
+        length += writeNumber(&msg[length], percent);
+        msg[length] = '%';
+        length++;
+    }
+    msg[length] = '\0';
+
+    DefineStatusMessage(&msg[0], 0, TEXT_COLOR_BLACK, 0);
+    DisplayStatusArea();
+}
+
+// Write a number into a string as digits, returning how many characters it took
+int writeNumber(char *s, int number)
+{
+    int digits = 1;
+    for (int n = number; n >= 10; n /= 10)
+    {
+        digits++;
+    }
+
+    for (int i = digits - 1; i >= 0; i--)
+    {
+        s[i] = 0x30 + modulo(number, 10);
+        number /= 10;
+    }
+
+    return digits;
+}
+
+// Copy text into a string including its terminator, returning how many characters it took without it
+int writeText(char *s, char *text)
+{
+    int length = 0;
+    while (text[length] != '\0')
+    {
+        s[length] = text[length];
+        length++;
+    }
+    s[length] = '\0';
+
+    return length;
+}
+
+// Add a byte to the flythrough file, writing it out a buffer at a time
+void streamByte(int byte)
+{
+    stream[streamLength] = byte;
+    streamLength++;
+
+    if (streamLength == ZOOM_BUFFER)
+    {
+        streamFlush();
+    }
+}
+
+// Add 4 bits to the flythrough file, high half of the byte first
+void streamNibble(int nibble)
+{
+    if (streamHalf < 0)
+    {
+        streamHalf = nibble;
+    }
+    else
+    {
+        streamByte((streamHalf << 4) | nibble);
+        streamHalf = -1;
+    }
+}
+
+// Add a run length from 0 to 255 to the flythrough file, as a nibble if it is under 15 or 15 and then the whole length
+void streamCount(int count)
+{
+    if (count < 15)
+    {
+        streamNibble(count);
+    }
+    else
+    {
+        streamNibble(15);
+        streamNibble(count >> 4);
+        streamNibble(count & 0xF);
+    }
+}
+
+// Write the buffer to the flythrough file, dropping anything past the end of it
+void streamFlush()
+{
+    int size = ZOOM_FILE_SIZE - streamPosition;
+    if (streamLength < size)
+    {
+        size = streamLength;
+    }
+
+    if (size > 0 && Bfile_WriteFile_OS(zoomFile, stream, size) < 0)
+    {
+        streamError = 1;
+    }
+
+    streamPosition += streamLength;
+    streamLength = 0;
+}
+
+// Read the next 4 bits of the flythrough file
+int readNibble()
+{
+    if (streamHalf < 0)
+    {
+        int byte = readByte();
+        streamHalf = byte & 0xF;
+        return byte >> 4;
+    }
+
+    int nibble = streamHalf;
+    streamHalf = -1;
+    return nibble;
+}
+
+// Read a run length written by streamCount()
+int readCount()
+{
+    int count = readNibble();
+    if (count == 15)
+    {
+        count = readNibble() << 4;
+        count |= readNibble();
+    }
+
+    return count;
+}
+
+// Read the next byte of the flythrough file, 0 once it has run out
+int readByte()
+{
+    if (streamRead == streamLength)
+    {
+        streamLength = Bfile_ReadFile_OS(zoomFile, stream, ZOOM_BUFFER, -1);
+        streamRead = 0;
+
+        if (streamLength <= 0)
+        {
+            streamLength = 0;
+            return 0;
+        }
+    }
+
+    streamRead++;
+    return stream[streamRead - 1];
+}
+
+void main(void) 
+{
+    //Clear VRAM ready to write to
+    Bdisp_AllClr_VRAM();
+
+    // Bypass 3 bit 8 colour mode
+    Bdisp_EnableColor(ADVANCED_COLOUR);
+
+    // Setup header
+    char color1 = TEXT_COLOR_WHITE;
+    char color2 = TEXT_COLOR_WHITE;
+    char msg[5] = "Menu";
+    DefineStatusMessage(&msg[0], 0, TEXT_COLOR_BLACK, 0);
+    DefineStatusAreaFlags(4, SAF_BATTERY | SAF_TEXT | SAF_ALPHA_SHIFT, &color1, &color2);
+    EnableDisplayHeader(2, 2);
+
+    PrintXY(1, 1, "  F1: Mandelbrot", TEXT_MODE_NORMAL, TEXT_COLOR_BLACK);
+    PrintXY(1, 2, "  F2: Record Zoom", TEXT_MODE_NORMAL, TEXT_COLOR_BLACK);
+    PrintXY(1, 3, "  F3: Play Zoom", TEXT_MODE_NORMAL, TEXT_COLOR_BLACK);
+    PrintXY(1, 8, "  F6: Settings ->", TEXT_MODE_NORMAL, TEXT_COLOR_BLACK);
+
+    while(1)
+    {
+        GetKey(&key);
+
+        // If key is F1, render mandelbrot
+        if (key == 0x7539)
+        {
+            renderMandlebrot();
+        }
+
+        // If key is F2, record a zoom flythrough
+        else if (key == 0x753A)
+        {
+            recordZoom();
+        }
+
+        // If key is F3, play the last zoom flythrough
+        else if (key == 0x753B)
+        {
+            playZoom();
+        }
+
+        // If key is F6, render mandlebrot
+        else if (key == 0x753E|| key == 0x7545)
+        {
+            editSettings();
+        }
+
+        // This should never be pressed, but if they do then this will force quit
+        else if (key == KEY_CTRL_EXE) 
+        {
+            break;
+        }
+    }
+    return; // Main can never return, so this call should never be reached
+}
+
+// Add a line to the overlay and draw it over the render, returning where it is in the overlay or -1 if there is no room
+int overlayAdd(int x1, int y1, int x2, int y2, unsigned short color, int layer)
+{
+    // Anything past the budget is simply not drawn
+    if (overlayCount == OVERLAY_LINES)
+    {
+        return -1;
+    }
+
+    overlay[overlayCount].x1 = x1;
+    overlay[overlayCount].y1 = y1;
+    overlay[overlayCount].x2 = x2;
+    overlay[overlayCount].y2 = y2;
+    overlay[overlayCount].color = color;
+    overlay[overlayCount].layer = layer;
+    overlay[overlayCount].segment = -1;
+    overlay[overlayCount].saved = savedCount;
+
+    markDirty(y1, y2);
+    overlayDraw(overlayCount, 0, HEIGHT);
+    overlayCount++;
+
+    return overlayCount - 1;
+}
+
+// Remove every line in a layer, restoring the render underneath
+void overlayRemove(int layer)
+{
+    // Find the first line being removed
+    int first;
+    for (first = 0; first < overlayCount; first++)
+    {
+        if (overlay[first].layer == layer)
+        {
+            break;
+        }
+    }
+
+    if (first == overlayCount)
+    {
+        return;
+    }
+
+    overlayLift(first);
+
+    // Pack the lines that are staying down and draw them back on top
+    int count = first;
+    for (int i = first; i < overlayCount; i++)
+    {
+        if (overlay[i].layer != layer)
+        {
+            overlay[count] = overlay[i];
+            overlay[count].saved = savedCount;
+            overlayDraw(count, 0, HEIGHT);
+            count++;
+        }
+    }
+    overlayCount = count;
+}
+
+// Remove everything from the overlay
+void overlayClear()
+{
+    if (overlayCount > 0)
+    {
+        overlayLift(0);
+        overlayCount = 0;
+    }
+
+    dirtyTop = HEIGHT + 1;
+    dirtyBottom = -1;
+}
+
+// Push the rows the overlay has changed to the screen
+void overlayFlush()
+{
+    if (dirtyBottom >= dirtyTop)
+    {
+        Bdisp_PutDisp_DD_stripe(dirtyTop, dirtyBottom);
+    }
+
+    dirtyTop = HEIGHT + 1;
+    dirtyBottom = -1;
+}
+
+// Restore the render under every line from first onwards, then redraw any earlier lines they covered up
+void overlayLift(int first)
+{
+    for (int i = first; i < overlayCount; i++)
+    {
+        markDirty(overlay[i].y1, overlay[i].y2);
+    }
+
+    while (savedCount > overlay[first].saved)
+    {
+        savedCount--;
+        int x = savedX[savedCount];
+        int y = savedY[savedCount];
+        int bit = y * (WIDTH + 1) + x;
+
+        Bdisp_SetPoint_VRAM(x, y, savedColor[savedCount]);
+        overlayMask[bit >> 3] &= ~(1 << (bit & 7));
+        markDirty(y, y);
+    }
+
+    // Only lines crossing the changed rows can have been covered, and only those rows are redrawn so lines stay in order
+    for (int i = 0; i < first; i++)
+    {
+        if ((overlay[i].y1 >= dirtyTop || overlay[i].y2 >= dirtyTop) && (overlay[i].y1 <= dirtyBottom || overlay[i].y2 <= dirtyBottom))
+        {
+            overlayDraw(i, dirtyTop, dirtyBottom);
+        }
+    }
+}
+
+// Save the render colour of a pixel between rows top and bottom if it is not already saved, then draw over it
+void overlayPlot(int x, int y, unsigned short color, int top, int bottom)
+{
+    if (x < 0 || x > WIDTH || y < top || y > bottom)
+    {
+        return;
+    }
+
+    int bit = y * (WIDTH + 1) + x;
+    if ((overlayMask[bit >> 3] & (1 << (bit & 7))) == 0)
+    {
+        // Out of room to save the render, so leave it alone rather than lose it
+        // host/trace checks every cursor position fits, so this only guards against future changes
+        if (savedCount == OVERLAY_PIXELS)
+        {
+            return;
+        }
+
+        savedX[savedCount] = x;
+        savedY[savedCount] = y;
+        savedColor[savedCount] = Bdisp_GetPoint_VRAM(x, y);
+        savedCount++;
+        overlayMask[bit >> 3] |= 1 << (bit & 7);
+    }
+
+    Bdisp_SetPoint_VRAM(x, y, color);
+}
+
+// Widen the range of rows that need flushing, clipped to the screen
+void markDirty(int y1, int y2)
+{
+    if (y1 > y2)
+    {
+        int tmp = y1;
+        y1 = y2;
+        y2 = tmp;
+    }
+
+    if (y1 < 0)
+    {
+        y1 = 0;
+    }
+    if (y2 > HEIGHT)
+    {
+        y2 = HEIGHT;
+    }
+
+    if (y1 < dirtyTop)
+    {
+        dirtyTop = y1;
+    }
+    if (y2 > dirtyBottom)
+    {
+        dirtyBottom = y2;
     }
 }
 
 // A function I modified from here https://prizm.cemetech.net/Useful_Routines/DrawLine/ by Christopher Mitchell
-void Bdisp_EraseLine_VRAM(int x1, int y1, int x2, int y2) 
+void overlayDraw(int i, int top, int bottom) 
 {
+    int x1 = overlay[i].x1;
+    int y1 = overlay[i].y1;
+    int x2 = overlay[i].x2;
+    int y2 = overlay[i].y2;
+    unsigned short color = overlay[i].color;
     signed char ix;
     signed char iy;
 
     int delta_x = (x2 > x1?(ix = 1, x2 - x1):(ix = -1, x1 - x2)) << 1;
     int delta_y = (y2 > y1?(iy = 1, y2 - y1):(iy = -1, y1 - y2)) << 1;
  
-    mandlebrotPixel(x1 , y1);
+    overlayPlot(x1, y1, color, top, bottom); 
     if (delta_x >= delta_y) 
     {
         int error = delta_y - (delta_x >> 1);        
@@ -692,12 +2151,12 @@ void Bdisp_EraseLine_VRAM(int x1, int y1, int x2, int y2)
                 {
                     y1 += iy;
                     error -= delta_x;
-                }                          
+                }                           
             }
-                                        
+                                          
         x1 += ix;
         error += delta_y;
-        mandlebrotPixel(x1 , y1);   
+        overlayPlot(x1, y1, color, top, bottom);   
         }
     } 
     else 
@@ -715,14 +2174,7 @@ void Bdisp_EraseLine_VRAM(int x1, int y1, int x2, int y2)
             }                              
         y1 += iy;
         error += delta_x;  
-        mandlebrotPixel(x1 , y1);
+        overlayPlot(x1, y1, color, top, bottom);
         }
     }
-
-    if (AXIS == 1)
-    {
-        drawAxis();
-    }
-
-    return;
-}
\ No newline at end of file
+}
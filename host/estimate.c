@@ -0,0 +1,85 @@
+// Renders a spread of views and MAX_ITERATIONS settings the way renderMandlebrot() does, printing how far the
+// pre-pass estimate was from the real render time
+// Host doubles are much cheaper next to drawing than on the calculator, so PIXEL_COST weighs differently here
+#define main fractals_main
+#include "../Fractals.c"
+#undef main
+
+#include <stdio.h>
+#include <stdlib.h>
+
+typedef struct
+{
+    char *name;
+    double re;
+    double im;
+    double scale;
+} view;
+
+view views[] =
+{
+    {"whole set", 0, 0, 95},
+    {"main cardioid", -0.2, 0, 95 * 4},
+    {"seahorse valley", -0.75, 0.1, 95 * 8},
+    {"elephant valley", 0.28, 0.008, 95 * 32},
+    {"mini mandelbrot", -1.77, 0, 95 * 64},
+};
+
+int iterations[] = {20, 50, 99};
+
+extern int flushedRows;
+extern int statusRedraws;
+
+int main()
+{
+    int count = 0;
+    double sum = 0;
+    double worst = 0;
+
+    // The first render pays for touching VRAM and the tile arrays, so leave it out
+    int estimate;
+    renderTiles(&estimate);
+
+    printf("%-16s iters  estimate    actual  error\n", "view");
+    for (int v = 0; v < sizeof(views) / sizeof(views[0]); v++)
+    {
+        for (int i = 0; i < sizeof(iterations) / sizeof(iterations[0]); i++)
+        {
+            viewPoint.re = views[v].re;
+            viewPoint.im = views[v].im;
+            viewScale = views[v].scale;
+            MAX_ITERATIONS = iterations[i];
+            LIVE_RENDER = 1;
+
+            int ticks = renderTiles(&estimate);
+            double error = ticks > 0 ? 100.0 * (estimate - ticks) / ticks : 0;
+
+            printf("%-16s %5d %9d %9d %+5.0f%%\n", views[v].name, iterations[i], estimate, ticks, error);
+            sum += error < 0 ? -error : error;
+            if ((error < 0 ? -error : error) > worst)
+            {
+                worst = error < 0 ? -error : error;
+            }
+            count++;
+        }
+    }
+    printf("mean error %.0f%%, worst %.0f%%\n", sum / count, worst);
+
+    // Screen updates don't depend on the view, so one render per live render setting shows them all
+    printf("\nlive render  rows flushed  status redraws\n");
+    viewPoint.re = 0;
+    viewPoint.im = 0;
+    viewScale = ZOOM;
+    MAX_ITERATIONS = 20;
+    for (int mode = 0; mode < 4; mode++)
+    {
+        LIVE_RENDER = mode;
+        flushedRows = 0;
+        statusRedraws = 0;
+
+        renderTiles(&estimate);
+        printf("%11d %13d %15d\n", mode, flushedRows, statusRedraws);
+    }
+
+    return 0;
+}
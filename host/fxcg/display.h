@@ -0,0 +1,28 @@
+// Host stand-in for the libfxcg display header, only what Fractals.c uses
+#ifndef HOST_FXCG_DISPLAY_H
+#define HOST_FXCG_DISPLAY_H
+
+#define TEXT_COLOR_BLACK 0
+#define TEXT_COLOR_WHITE 7
+#define TEXT_MODE_NORMAL 0
+#define SAF_BATTERY 0x0001
+#define SAF_ALPHA_SHIFT 0x0002
+#define SAF_TEXT 0x0100
+
+void Bdisp_AllClr_VRAM(void);
+void Bdisp_PutDisp_DD(void);
+void Bdisp_PutDisp_DD_stripe(int y1, int y2);
+void Bdisp_SetPoint_VRAM(int x, int y, int color);
+unsigned short Bdisp_GetPoint_VRAM(int x, int y);
+void Bdisp_EnableColor(int n);
+void DefineStatusMessage(char *msg, short P2, char P3, char P4);
+void DefineStatusAreaFlags(int mode, int flags, char *color1, char *color2);
+void EnableDisplayHeader(int P1, int P2);
+int DisplayStatusArea(void);
+void PrintXY(int x, int y, const char *string, int mode, int color);
+void locate_OS(int x, int y);
+void Print_OS(const char *msg, int mode, int zero2);
+void Cursor_SetFlashOn(unsigned char cursor_type);
+void Cursor_SetFlashOff(void);
+
+#endif
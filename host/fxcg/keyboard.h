@@ -0,0 +1,9 @@
+// Host stand-in for the libfxcg keyboard header, only what Fractals.c uses
+#ifndef HOST_FXCG_KEYBOARD_H
+#define HOST_FXCG_KEYBOARD_H
+
+#define KEY_CTRL_EXE 30004
+
+int GetKey(int *key);
+
+#endif
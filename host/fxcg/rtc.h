@@ -0,0 +1,7 @@
+// Host stand-in for the libfxcg RTC header, only what Fractals.c uses
+#ifndef HOST_FXCG_RTC_H
+#define HOST_FXCG_RTC_H
+
+int RTC_GetTicks(void);
+
+#endif
@@ -0,0 +1,219 @@
+// Host versions of the calculator syscalls used by Fractals.c, so its rendering and flythrough code can be run and timed on a PC
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include <fxcg/display.h>
+#include <fxcg/keyboard.h>
+#include <fxcg/file.h>
+#include <fxcg/rtc.h>
+
+// The calculator runs doubles in software and takes about 25s for the default render, so host time is stretched by
+// this much to give ticks of about the same size
+#ifndef TICK_SCALE
+#define TICK_SCALE 5000
+#endif
+
+#define HOST_FILES 4
+
+unsigned short vram[216][384];
+FILE *hostFiles[HOST_FILES];
+
+// How much drawing to the screen was asked for, to check it stays cheap
+int flushedRows = 0;
+int statusRedraws = 0;
+
+// Display, drawn to a VRAM array that is never shown
+void Bdisp_AllClr_VRAM(void)
+{
+    memset(vram, 0xFF, sizeof(vram));
+}
+
+void Bdisp_PutDisp_DD(void)
+{
+    flushedRows += 216;
+}
+
+void Bdisp_PutDisp_DD_stripe(int y1, int y2)
+{
+    flushedRows += y2 - y1 + 1;
+}
+
+void Bdisp_SetPoint_VRAM(int x, int y, int color)
+{
+    if (x >= 0 && x < 384 && y >= 0 && y < 216)
+    {
+        vram[y][x] = color;
+    }
+}
+
+unsigned short Bdisp_GetPoint_VRAM(int x, int y)
+{
+    if (x >= 0 && x < 384 && y >= 0 && y < 216)
+    {
+        return vram[y][x];
+    }
+    return 0;
+}
+
+void Bdisp_EnableColor(int n)
+{
+}
+
+void DefineStatusMessage(char *msg, short P2, char P3, char P4)
+{
+}
+
+void DefineStatusAreaFlags(int mode, int flags, char *color1, char *color2)
+{
+}
+
+void EnableDisplayHeader(int P1, int P2)
+{
+}
+
+int DisplayStatusArea(void)
+{
+    statusRedraws++;
+    return 0;
+}
+
+void PrintXY(int x, int y, const char *string, int mode, int color)
+{
+}
+
+void locate_OS(int x, int y)
+{
+}
+
+void Print_OS(const char *msg, int mode, int zero2)
+{
+}
+
+void Cursor_SetFlashOn(unsigned char cursor_type)
+{
+}
+
+void Cursor_SetFlashOff(void)
+{
+}
+
+// The drivers never wait for keys, pressing EXIT if anything does
+int GetKey(int *key)
+{
+    *key = 0x7532;
+    return 1;
+}
+
+// Files, kept in the current directory under the last part of the calculator path
+static void hostName(const unsigned short *filename, char *name)
+{
+    int length = 0;
+    for (int i = 0; filename[i] != 0 && i < 31; i++)
+    {
+        if (filename[i] == '\\')
+        {
+            length = 0;
+        }
+        else
+        {
+            name[length++] = filename[i];
+        }
+    }
+    name[length] = 0;
+}
+
+void Bfile_StrToName_ncpy(unsigned short *dest, const char *source, size_t n)
+{
+    size_t i;
+    for (i = 0; i < n - 1 && source[i] != 0; i++)
+    {
+        dest[i] = (unsigned char)source[i];
+    }
+    dest[i] = 0;
+}
+
+int Bfile_DeleteEntry(const unsigned short *filename)
+{
+    char name[32];
+    hostName(filename, name);
+    return remove(name) == 0 ? 0 : -1;
+}
+
+// Calculator files are created at a fixed size and read back as zeros where nothing was written
+int Bfile_CreateEntry_OS(const unsigned short *filename, int mode, size_t *size)
+{
+    char name[32];
+    hostName(filename, name);
+
+    FILE *file = fopen(name, "wb");
+    if (file == NULL)
+    {
+        return -1;
+    }
+
+    static const char zeros[1024];
+    for (size_t i = 0; i < *size; i += sizeof(zeros))
+    {
+        fwrite(zeros, 1, *size - i < sizeof(zeros) ? *size - i : sizeof(zeros), file);
+    }
+    fclose(file);
+    return 0;
+}
+
+int Bfile_OpenFile_OS(const unsigned short *filename, int mode, int zero)
+{
+    char name[32];
+    hostName(filename, name);
+
+    for (int handle = 0; handle < HOST_FILES; handle++)
+    {
+        if (hostFiles[handle] == NULL)
+        {
+            hostFiles[handle] = fopen(name, mode == READ ? "rb" : "r+b");
+            return hostFiles[handle] == NULL ? -1 : handle;
+        }
+    }
+    return -1;
+}
+
+int Bfile_ReadFile_OS(int handle, void *buf, int size, int readpos)
+{
+    if (readpos >= 0)
+    {
+        fseek(hostFiles[handle], readpos, SEEK_SET);
+    }
+    return fread(buf, 1, size, hostFiles[handle]);
+}
+
+// Writes past the end of the file fail, as the calculator does not grow files
+int Bfile_WriteFile_OS(int handle, const void *buf, int size)
+{
+    long position = ftell(hostFiles[handle]);
+    fseek(hostFiles[handle], 0, SEEK_END);
+    long end = ftell(hostFiles[handle]);
+    fseek(hostFiles[handle], position, SEEK_SET);
+
+    if (position + size > end)
+    {
+        return -1;
+    }
+    return fwrite(buf, 1, size, hostFiles[handle]);
+}
+
+int Bfile_SeekFile_OS(int handle, int pos)
+{
+    return fseek(hostFiles[handle], pos, SEEK_SET) == 0 ? pos : -1;
+}
+
+int Bfile_CloseFile_OS(int handle)
+{
+    fclose(hostFiles[handle]);
+    hostFiles[handle] = NULL;
+    return 0;
+}
+
+// 128 ticks a second from midnight, like the calculator's clock, so scaled up a day passes every few seconds
+int RTC_GetTicks(void)
+{
+    return (long long)clock() * 128 * TICK_SCALE / CLOCKS_PER_SEC % (128 * 60 * 60 * 24);
+}
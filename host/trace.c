@@ -0,0 +1,159 @@
+// Draws the axies and a full MAX_ITERATIONS 99 trace from every cursor position, checking the overlay always has room to
+// save the render under them, and that taking them off again leaves the render as it was
+// Then walks the cursor over every position in follow mode, checking the screen matches the overlay drawn from scratch
+// and counting how many segments each move redraws
+#define main fractals_main
+#include "../Fractals.c"
+#undef main
+
+#include <stdio.h>
+#include <string.h>
+
+extern unsigned short vram[216][384];
+unsigned short render[216][384];
+
+// Whether the screen is what drawing every overlay line in order over the render gives
+int overlayMatches()
+{
+    static unsigned short screen[216][384];
+    static unsigned char mask[sizeof(overlayMask)];
+    static unsigned short x[OVERLAY_PIXELS];
+    static unsigned char y[OVERLAY_PIXELS];
+    static unsigned short color[OVERLAY_PIXELS];
+    static int saved[OVERLAY_LINES];
+
+    memcpy(screen, vram, sizeof(vram));
+    memcpy(mask, overlayMask, sizeof(mask));
+    memcpy(x, savedX, sizeof(x));
+    memcpy(y, savedY, sizeof(y));
+    memcpy(color, savedColor, sizeof(color));
+    int count = savedCount;
+    for (int i = 0; i < overlayCount; i++)
+    {
+        saved[i] = overlay[i].saved;
+    }
+
+    memcpy(vram, render, sizeof(vram));
+    memset(overlayMask, 0, sizeof(overlayMask));
+    savedCount = 0;
+    for (int i = 0; i < overlayCount; i++)
+    {
+        overlay[i].saved = savedCount;
+        overlayDraw(i, 0, HEIGHT);
+    }
+    int matches = memcmp(screen, vram, sizeof(vram)) == 0;
+
+    memcpy(vram, screen, sizeof(vram));
+    memcpy(overlayMask, mask, sizeof(mask));
+    memcpy(savedX, x, sizeof(x));
+    memcpy(savedY, y, sizeof(y));
+    memcpy(savedColor, color, sizeof(color));
+    savedCount = count;
+    for (int i = 0; i < overlayCount; i++)
+    {
+        overlay[i].saved = saved[i];
+    }
+
+    return matches;
+}
+
+// Move the follow trace like setTrace() does, returning how many of the new orbit's segments moved
+int followCursor(int x, int y)
+{
+    int newX[MAX_ORBIT];
+    int newY[MAX_ORBIT];
+    int newLength = computeOrbit(x, y, newX, newY);
+
+    int moved = 0;
+    for (int i = 0; i < newLength - 1; i++)
+    {
+        if (i >= orbitLength - 1 || orbitX[i] != newX[i] || orbitY[i] != newY[i] || orbitX[i + 1] != newX[i + 1] || orbitY[i + 1] != newY[i + 1])
+        {
+            moved++;
+        }
+    }
+
+    overlayRemove(LAYER_CURSOR);
+    followTrace(x, y);
+    overlayAdd(x, y, x, y, 0xf800, LAYER_CURSOR);
+    overlayFlush();
+
+    return moved;
+}
+
+int main()
+{
+    MAX_ITERATIONS = 99;
+    LIVE_RENDER = 1;
+
+    int estimate;
+    renderTiles(&estimate);
+    memcpy(render, vram, sizeof(vram));
+
+    overlayClear();
+    drawAxis();
+    int axis = savedCount;
+
+    int worst = 0;
+    int worstX = 0;
+    int worstY = 0;
+    int full = 0;
+    for (int y = 24; y <= HEIGHT; y++)
+    {
+        for (int x = 0; x <= WIDTH; x++)
+        {
+            orbitLength = computeOrbit(x, y, orbitX, orbitY);
+            drawOrbit();
+            overlayAdd(x, y, x, y, 0xf800, LAYER_CURSOR);
+
+            if (savedCount > worst)
+            {
+                worst = savedCount;
+                worstX = x;
+                worstY = y;
+            }
+            if (savedCount == OVERLAY_PIXELS)
+            {
+                full++;
+            }
+
+            overlayRemove(LAYER_CURSOR);
+            overlayRemove(LAYER_TRACE);
+        }
+    }
+    overlayClear();
+
+    int restored = memcmp(render, vram, sizeof(vram)) == 0 && savedCount == 0;
+    printf("axies save %d pixels, axies and trace at most %d at %d,%d of %d\n", axis, worst, worstX, worstY, OVERLAY_PIXELS);
+    printf("%d cursor positions ran out of room, render %s\n", full, restored ? "restored" : "damaged");
+
+    // Sweep back and forth along each row, as holding an arrow key would
+    drawAxis();
+    orbitLength = 0;
+    long long moved = 0;
+    long long segments = 0;
+    int wrong = 0;
+    int checks = 0;
+    for (int y = 24; y <= HEIGHT; y++)
+    {
+        for (int i = 0; i <= WIDTH; i++)
+        {
+            int x = (y & 1) ? WIDTH - i : i;
+            moved += followCursor(x, y);
+            segments += orbitLength - 1;
+
+            if ((x * 7 + y) % 97 == 0)
+            {
+                checks++;
+                wrong += !overlayMatches();
+            }
+        }
+    }
+    overlayClear();
+
+    int followRestored = memcmp(render, vram, sizeof(vram)) == 0 && savedCount == 0;
+    printf("follow mode redrew %lld of %lld segments (%.0f%%), %d of %d checks wrong, render %s\n", moved, segments,
+        100.0 * moved / segments, wrong, checks, followRestored ? "restored" : "damaged");
+
+    return full > 0 || !restored || wrong > 0 || !followRestored;
+}
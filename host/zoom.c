@@ -0,0 +1,273 @@
+// Records each flythrough in zoom.txt the way recordZoom() does, printing every frame's time against renderMandlebrot()
+// drawing the same view and how far it is from an exact render, then plays the file back and checks every frame comes
+// out the same
+// Run with -p and a ZOOM.bin copied from the calculator, under another name as ZOOM.bin gets written over, to record the
+// same flythrough here and print the costs the calculator stored next to each frame
+#define main fractals_main
+#include "../Fractals.c"
+#undef main
+
+#include <stdio.h>
+#include <string.h>
+
+unsigned char recorded[ZOOM_FRAMES + 2][ZOOM_HEIGHT][ZOOM_WIDTH];
+unsigned char exact[ZOOM_HEIGHT][ZOOM_WIDTH];
+
+// Costs read from a calculator recording, in the same per 1000 as zoomStep() returns
+int stored[256];
+int storedFrames = 0;
+
+// Percentage of pixels in the current frame that an exact render would give a different count
+double wrongPixels()
+{
+    unsigned char made[ZOOM_HEIGHT][ZOOM_WIDTH];
+    memcpy(made, frame, sizeof(frame));
+
+    exactFrame();
+    memcpy(exact, frame, sizeof(frame));
+    memcpy(frame, made, sizeof(frame));
+
+    int wrong = 0;
+    for (int y = 0; y < ZOOM_HEIGHT; y++)
+    {
+        for (int x = 0; x < ZOOM_WIDTH; x++)
+        {
+            if ((exact[y][x] & 0x7F) != (made[y][x] & 0x7F))
+            {
+                wrong++;
+            }
+        }
+    }
+
+    return 100.0 * wrong / (ZOOM_WIDTH * ZOOM_HEIGHT);
+}
+
+void keepFrame(int number)
+{
+    for (int y = 0; y < ZOOM_HEIGHT; y++)
+    {
+        for (int x = 0; x < ZOOM_WIDTH; x++)
+        {
+            recorded[number][y][x] = frame[y][x] & 0x7F;
+        }
+    }
+}
+
+// Play back ZOOM.bin, returning the first frame that differs from what was recorded, or -1 if they all match
+int checkPlayback(int frames)
+{
+    int maxIterations;
+    if (readZoomHeader(&maxIterations) != frames)
+    {
+        return 0;
+    }
+
+    for (int i = 0; i < frames; i++)
+    {
+        playStep();
+        for (int y = 0; y < ZOOM_HEIGHT; y++)
+        {
+            for (int x = 0; x < ZOOM_WIDTH; x++)
+            {
+                if ((frame[y][x] & 0x7F) != recorded[i][y][x])
+                {
+                    Bfile_CloseFile_OS(zoomFile);
+                    return i;
+                }
+            }
+        }
+    }
+
+    Bfile_CloseFile_OS(zoomFile);
+    return -1;
+}
+
+// Ticks renderMandlebrot() takes to draw the current frame's view from scratch
+int renderTicks()
+{
+    // The render puts X_OFFSET, Y_OFFSET on viewPoint, and its rows start under the status bar
+    viewScale = zoomScale;
+    viewPoint.re = zoomPoint.re + (X_OFFSET - zoomX) / zoomScale;
+    viewPoint.im = zoomPoint.im + (Y_OFFSET - 24 - zoomY) / zoomScale;
+
+    int estimate;
+    int ticks = renderTiles(&estimate);
+
+    viewScale = ZOOM;
+    viewPoint.re = 0;
+    viewPoint.im = 0;
+    return ticks;
+}
+
+// End a frame's line with the cost the calculator stored for it, if replaying one of its recordings
+void printStored(int number)
+{
+    if (number < storedFrames)
+    {
+        printf("  calculator %d%%", stored[number] / 10);
+    }
+    printf("\n");
+}
+
+int record(int iterations, int x, int y)
+{
+    MAX_ITERATIONS = iterations;
+    zoomX = x;
+    zoomY = y;
+    printf("MAX_ITERATIONS %d zoom point %d,%d checked every %d frames\n", iterations, x, y, ZOOM_CHECK_FRAMES);
+    printf("frame  ticks render   real  estimate   bytes  wrong\n");
+
+    startZoom();
+    if (openZoom() == 0)
+    {
+        printf("can't create ZOOM.bin\n");
+        return 1;
+    }
+
+    int start = RTC_GetTicks();
+    firstFrame();
+    int ticks = ticksSince(start);
+    int render = renderTicks();
+    encodeFrame(0, 1000);
+    keepFrame(0);
+    printf("%5d %6d %6d %5d%% %8d%% %7d  exact", 0, ticks, render, 100 * ticks / render, 100, streamPosition + streamLength);
+    printStored(0);
+
+    int frames = 1;
+    int full = 0;
+    long long zoomTicks = 0;
+    long long zoomRender = 0;
+    long long checkTicks = 0;
+    long long checkRender = 0;
+    int costs = 0;
+    double worst = 0;
+    for (int i = 1; i <= ZOOM_FRAMES; i++)
+    {
+        start = RTC_GetTicks();
+        int cost = zoomStep(i);
+        ticks = ticksSince(start);
+
+        if (streamPosition + streamLength > ZOOM_FILE_SIZE)
+        {
+            full = 1;
+            break;
+        }
+        frames++;
+        costs += cost;
+        keepFrame(i);
+
+        render = renderTicks();
+        if (modulo(i, ZOOM_CHECK_FRAMES) == 0)
+        {
+            checkTicks += ticks;
+            checkRender += render;
+        }
+        else
+        {
+            zoomTicks += ticks;
+            zoomRender += render;
+        }
+
+        double wrong = wrongPixels();
+        if (wrong > worst)
+        {
+            worst = wrong;
+        }
+        printf("%5d %6d %6d %5d%% %8d%% %7d %5.1f%%%s", i, ticks, render, 100 * ticks / render, cost / 10,
+            streamPosition + streamLength, wrong, modulo(i, ZOOM_CHECK_FRAMES) == 0 ? "  checked" : "");
+        printStored(i);
+    }
+
+    if (full == 0 && streamPosition + streamLength + ZOOM_FRAME_MAX > ZOOM_FILE_SIZE)
+    {
+        full = 1;
+    }
+    if (closeZoom(frames) == 0)
+    {
+        printf("can't save ZOOM.bin\n");
+        return 1;
+    }
+
+    int mismatch = checkPlayback(frames);
+    printf("%d frames%s, worst %.1f%% of pixels wrong, playback %s\n", frames, full ? " (file full)" : "", worst,
+        mismatch < 0 ? "matches" : "differs");
+    printf("against a full render, frames took %lld%% and checked frames %lld%%, zoomStep() estimated %d%% on average\n\n",
+        zoomRender > 0 ? 100 * zoomTicks / zoomRender : 0, checkRender > 0 ? 100 * checkTicks / checkRender : 0,
+        frames > 1 ? costs / ((frames - 1) * 10) : 100);
+
+    return mismatch >= 0;
+}
+
+// Record the flythrough from a calculator's ZOOM.bin again, showing the costs it stored next to the ones measured here
+int replay(char *name)
+{
+    if (strcmp(name, "ZOOM.bin") != 0)
+    {
+        FILE *from = fopen(name, "rb");
+        FILE *to = fopen("ZOOM.bin", "wb");
+        if (from == NULL || to == NULL)
+        {
+            printf("can't copy %s to ZOOM.bin\n", name);
+            return 1;
+        }
+
+        char buffer[4096];
+        size_t size;
+        while ((size = fread(buffer, 1, sizeof(buffer), from)) > 0)
+        {
+            fwrite(buffer, 1, size, to);
+        }
+        fclose(from);
+        fclose(to);
+    }
+
+    int maxIterations;
+    storedFrames = readZoomHeader(&maxIterations);
+    if (storedFrames == 0)
+    {
+        printf("no zoom in %s\n", name);
+        return 1;
+    }
+
+    for (int i = 0; i < storedFrames; i++)
+    {
+        stored[i] = playStep();
+    }
+    Bfile_CloseFile_OS(zoomFile);
+
+    return record(maxIterations, zoomX, zoomY);
+}
+
+int main(int argc, char **argv)
+{
+    if (argc > 1 && strcmp(argv[1], "-p") == 0)
+    {
+        if (argc < 3)
+        {
+            printf("usage: zoom -p <copy of the calculator's ZOOM.bin>\n");
+            return 1;
+        }
+        return replay(argv[2]);
+    }
+
+    FILE *script = fopen(argc > 1 ? argv[1] : "zoom.txt", "r");
+    if (script == NULL)
+    {
+        printf("can't open script\n");
+        return 1;
+    }
+
+    char line[128];
+    int failed = 0;
+    while (fgets(line, sizeof(line), script) != NULL)
+    {
+        int iterations, x, y;
+        if (line[0] != '#' && sscanf(line, "%d %d %d", &iterations, &x, &y) == 3)
+        {
+            failed |= record(iterations, x, y);
+        }
+    }
+    fclose(script);
+
+    return failed;
+}